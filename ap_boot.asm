@@ -0,0 +1,76 @@
+; ap_boot.asm
+;
+; Real-mode start-up code for the application processors (APs).
+;
+; SMP::init() copies the bytes between _ap_trampoline_start and
+; _ap_trampoline_end to AP_TRAMPOLINE_BASE (a page below 1 MB; the SIPI
+; vector is its page number), fills in the three parameters at the end,
+; and sends INIT-SIPI-SIPI. Each AP then starts here in real mode at
+; AP_TRAMPOLINE_BASE:0, switches to protected mode with a flat GDT, turns
+; on PAE paging with the kernel's page table, loads its stack, and calls
+; the C++ entry point. All addresses are computed relative to the copy.
+
+AP_TRAMPOLINE_BASE equ 0x8000         ; keep in sync with smp.H
+
+%define REL(x) (AP_TRAMPOLINE_BASE + (x) - _ap_trampoline_start)
+
+global _ap_trampoline_start
+global _ap_trampoline_end
+global _ap_param_cr3
+global _ap_param_stack
+global _ap_param_entry
+
+SECTION .text
+
+[BITS 16]
+_ap_trampoline_start:
+    cli
+    cld
+    xor ax, ax
+    mov ds, ax
+    lgdt [REL(ap_gdt_desc)]
+    mov eax, cr0
+    or eax, 1                       ; PE
+    mov cr0, eax
+    jmp dword 0x08:REL(ap_protected)
+
+[BITS 32]
+ap_protected:
+    mov ax, 0x10
+    mov ds, ax
+    mov es, ax
+    mov fs, ax
+    mov gs, ax
+    mov ss, ax
+
+    mov eax, cr4
+    or eax, 1 << 5                  ; PAE
+    mov cr4, eax
+    mov eax, [REL(_ap_param_cr3)]
+    mov cr3, eax
+    mov eax, cr0
+    or eax, 0x80000000              ; PG
+    mov cr0, eax
+
+    mov esp, [REL(_ap_param_stack)]
+    mov eax, [REL(_ap_param_entry)]
+    call eax                        ; does not return
+.halt:
+    cli
+    hlt
+    jmp .halt
+
+ALIGN 8
+ap_gdt:
+    dq 0                            ; null
+    dq 0x00CF9A000000FFFF           ; 0x08: code, flat 4 GB
+    dq 0x00CF92000000FFFF           ; 0x10: data, flat 4 GB
+ap_gdt_desc:
+    dw ap_gdt_desc - ap_gdt - 1
+    dd REL(ap_gdt)
+
+ALIGN 4
+_ap_param_cr3:   dd 0               ; PDPT of the kernel page table
+_ap_param_stack: dd 0               ; initial ESP
+_ap_param_entry: dd 0               ; void (*)(), called with the stack above
+_ap_trampoline_end:
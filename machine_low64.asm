@@ -0,0 +1,20 @@
+; File: machine_low64.asm
+;
+; Low level CPU handling functions (64-bit build).
+;
+; See machine_low.asm for the 32-bit version.
+
+[BITS 64]
+
+; ----------------------------------------------------------------------
+; get_EFLAGS()
+; 
+; Returns value of the RFLAGS status register. 
+;
+; ----------------------------------------------------------------------
+global _get_EFLAGS
+; this function is exported.
+_get_EFLAGS:
+	pushfq			; push rflags
+	pop	rax		; pop contents into rax
+	ret
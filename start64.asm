@@ -0,0 +1,163 @@
+; File: start64.asm
+;
+; Kernel entry point for the 64-bit (x86-64) build.
+;
+; The multiboot loader enters us in 32-bit protected mode with paging off,
+; just like in start.asm. Before we can call main we switch to long mode:
+;
+;   1. build 4-level page tables that map the first DIRECT_MAP_GB GB of
+;      physical memory 1:1 with 2 MB pages (write-back; PageTable::
+;      init_paging later unmaps the parts that are not RAM, such as the
+;      PCI hole, before any device is touched),
+;   2. enable PAE, load CR3, set EFER.LME, enable paging,
+;   3. load a GDT with a 64-bit code segment and far-jump into it.
+;
+; DIRECT_MAP_GB must match Machine::DIRECT_MAP_GB in machine.H.
+
+DIRECT_MAP_GB   equ 16
+
+[BITS 32]
+global start
+start:
+    mov esp, _sys_stack     ; This points the stack to our new stack area
+    jmp stublet
+
+; This part MUST be 4byte aligned, so we solve that issue using 'ALIGN 4'
+ALIGN 4
+mboot:
+    ; Multiboot macros to make a few lines later more readable
+    MULTIBOOT_PAGE_ALIGN	equ 1<<0
+    MULTIBOOT_MEMORY_INFO	equ 1<<1
+    MULTIBOOT_AOUT_KLUDGE	equ 1<<16
+    MULTIBOOT_HEADER_MAGIC	equ 0x1BADB002
+    MULTIBOOT_HEADER_FLAGS	equ MULTIBOOT_PAGE_ALIGN | MULTIBOOT_MEMORY_INFO | MULTIBOOT_AOUT_KLUDGE
+    MULTIBOOT_CHECKSUM	equ -(MULTIBOOT_HEADER_MAGIC + MULTIBOOT_HEADER_FLAGS)
+    EXTERN code, bss, end
+
+    ; This is the GRUB Multiboot header. A boot signature
+    dd MULTIBOOT_HEADER_MAGIC
+    dd MULTIBOOT_HEADER_FLAGS
+    dd MULTIBOOT_CHECKSUM
+    
+    ; AOUT kludge - must be physical addresses. Make a note of these:
+    ; The linker script fills in the data for these ones!
+    dd mboot
+    dd code
+    dd bss
+    dd end
+    dd start
+
+stublet:
+    ; -- Is long mode available at all? (CPUID 0x80000001, EDX bit 29)
+    mov eax, 0x80000000
+    cpuid
+    cmp eax, 0x80000001
+    jb no_long_mode
+    mov eax, 0x80000001
+    cpuid
+    test edx, 1 << 29
+    jz no_long_mode
+
+    ; -- PML4[0] -> PDPT
+    mov eax, pdpt
+    or eax, 0x3                 ; present, writable
+    mov [pml4], eax
+
+    ; -- PDPT[i] -> directory i, for each GB of the direct map
+    xor ecx, ecx
+.fill_pdpt:
+    mov eax, ecx
+    shl eax, 12
+    add eax, directories
+    or eax, 0x3
+    mov [pdpt + ecx * 8], eax
+    inc ecx
+    cmp ecx, DIRECT_MAP_GB
+    jne .fill_pdpt
+
+    ; -- Directory entry i maps the 2 MB page at i * 2 MB
+    xor ecx, ecx
+.fill_directories:
+    mov eax, ecx
+    shl eax, 21
+    or eax, 0x83                ; present, writable, 2 MB page
+    mov [directories + ecx * 8], eax
+    mov eax, ecx
+    shr eax, 11                 ; bits 32 and up of the address
+    mov [directories + ecx * 8 + 4], eax
+    inc ecx
+    cmp ecx, DIRECT_MAP_GB * 512
+    jne .fill_directories
+
+    ; -- Enable PAE, point CR3 at the PML4, set EFER.LME, enable paging
+    mov eax, cr4
+    or eax, 1 << 5
+    mov cr4, eax
+
+    mov eax, pml4
+    mov cr3, eax
+
+    mov ecx, 0xC0000080         ; EFER
+    rdmsr
+    or eax, 1 << 8              ; LME
+    wrmsr
+
+    mov eax, cr0
+    or eax, 1 << 31
+    mov cr0, eax
+
+    ; -- We are in compatibility mode now. Load a GDT with a 64-bit code
+    ;    segment and jump to it.
+    lgdt [gdt64.pointer]
+    jmp gdt64.code:long_mode
+
+no_long_mode:
+    ; No way to print without the console; just stop.
+    cli
+    hlt
+    jmp no_long_mode
+
+[BITS 64]
+long_mode:
+    mov ax, gdt64.data
+    mov ds, ax
+    mov es, ax
+    mov fs, ax
+    mov gs, ax
+    mov ss, ax
+    mov rsp, _sys_stack
+
+    extern _main
+    call _main
+    jmp $
+
+; ----------------------------------------------------------------------
+; GDT for long mode: null, 64-bit code, data.
+; ----------------------------------------------------------------------
+SECTION .data
+ALIGN 8
+gdt64:
+    dq 0
+.code: equ $ - gdt64
+    dq (1 << 43) | (1 << 44) | (1 << 47) | (1 << 53)   ; code, S, present, L
+.data: equ $ - gdt64
+    dq (1 << 41) | (1 << 44) | (1 << 47)               ; writable, S, present
+.pointer:
+    dw $ - gdt64 - 1
+    dq gdt64
+
+; ----------------------------------------------------------------------
+; Page tables and stack. The loader zero-fills the BSS.
+; ----------------------------------------------------------------------
+SECTION .bss
+ALIGNB 4096
+pml4:
+    resb 4096
+pdpt:
+    resb 4096
+directories:
+    resb 4096 * DIRECT_MAP_GB
+
+ALIGNB 16
+    resb 8192               ; This reserves 8KBytes of memory here
+_sys_stack: